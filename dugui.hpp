@@ -5,6 +5,20 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cctype>
+#include <limits>
+#include <tuple>
+#include <variant>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <optional>
+#include <exception>
 
 #include <iostream>
 
@@ -20,7 +34,10 @@ enum class WidgetType {
 	FloatEdit,
 	CheckBox,
 	SpinBox,
-	Button
+	Button,
+	LogView,
+	Progress,
+	ComboBox
 };
 
 struct DuGuiError : std::logic_error {
@@ -29,6 +46,285 @@ struct DuGuiError : std::logic_error {
 
 class Widget;
 struct PropertyGroup;
+class TaskContext;
+class PrefixIndex;
+
+// Objects that are alive, to check that opening and closing windows doesn't leak anything
+struct LiveObjects {
+	std::atomic<long long> widgets = 0;
+	std::atomic<long long> properties = 0;
+	std::atomic<long long> backends = 0;
+	std::atomic<long long> nativeWidgets = 0;
+	// Sum of sizeof() of the counted objects, widgets counted as Widget whatever their type and without
+	// the memory their strings, functions and vectors allocate, so it only shows whether something stays alive
+	std::atomic<long long> shallowBytes = 0;
+
+	static LiveObjects& get() {
+		static LiveObjects live;
+		return live;
+	}
+};
+
+// Member that keeps its owner counted in LiveObjects, copies included
+template <typename Owner, std::atomic<long long> LiveObjects::*counter>
+class LiveCount {
+	static void add(long long difference) {
+		LiveObjects& live = LiveObjects::get();
+		(live.*counter) += difference;
+		live.shallowBytes += difference * (long long)sizeof(Owner);
+	}
+public:
+	LiveCount() {
+		add(1);
+	}
+	LiveCount(const LiveCount&) {
+		add(1);
+	}
+	LiveCount& operator=(const LiveCount&) {
+		return *this;
+	}
+	~LiveCount() {
+		add(-1);
+	}
+};
+
+// Bounded storage of log lines, written from any thread and read by the GUI thread
+class LogBuffer {
+	mutable std::mutex _mutex;
+	std::deque<std::string> _lines;
+	std::size_t _bytes = 0;
+	std::size_t _maxLines = 0;
+	std::size_t _maxBytes = 0;
+	std::atomic<unsigned long long> _appended = 0;
+	std::atomic<unsigned long long> _dropped = 0;
+	std::atomic<unsigned long long> _changes = 0;
+
+	void trim() {
+		while (!_lines.empty() && ((_maxLines && _lines.size() > _maxLines) || (_maxBytes && _bytes > _maxBytes))) {
+			_bytes -= _lines.front().size();
+			_lines.pop_front();
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+public:
+	LogBuffer(std::size_t maxLines = 0, std::size_t maxBytes = 0) : _maxLines(maxLines), _maxBytes(maxBytes) {
+	}
+
+	void limit(std::size_t maxLines, std::size_t maxBytes) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_maxLines = maxLines;
+		_maxBytes = maxBytes;
+		trim();
+	}
+
+	void append(const std::string& text) {
+		// Splitting happens before locking, so that readers wait only for the lines to be moved in
+		std::vector<std::string> split;
+		std::size_t start = 0;
+		for (std::size_t end = text.find('\n'); end != std::string::npos; end = text.find('\n', start)) {
+			split.emplace_back(text, start, end - start);
+			start = end + 1;
+		}
+		if (start < text.size() || start == 0)
+			split.emplace_back(text, start);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& it : split) {
+			_bytes += it.size();
+			_lines.push_back(std::move(it));
+		}
+		_appended.fetch_add(split.size(), std::memory_order_relaxed);
+		trim();
+		_changes.fetch_add(1, std::memory_order_release);
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_dropped.fetch_add(_lines.size(), std::memory_order_relaxed);
+		_lines.clear();
+		_bytes = 0;
+		_changes.fetch_add(1, std::memory_order_release);
+	}
+
+	// Counters that only grow, a reader compares them with the values it has seen to find out what changed
+	unsigned long long appended() const {
+		return _appended.load(std::memory_order_relaxed);
+	}
+	unsigned long long dropped() const {
+		return _dropped.load(std::memory_order_relaxed);
+	}
+	// Grows with every append() and clear(), cheaper to poll than the lines
+	unsigned long long changes() const {
+		return _changes.load(std::memory_order_acquire);
+	}
+
+	std::size_t size() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _lines.size();
+	}
+	std::size_t bytes() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _bytes;
+	}
+
+	// Copies of the requested lines, so that nothing is done with them while the writers are locked out
+	std::vector<std::string> lines(std::size_t first, std::size_t count) const {
+		std::vector<std::string> copied;
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (std::size_t i = first; i < _lines.size() && i < first + count; i++)
+			copied.push_back(_lines[i]);
+		return copied;
+	}
+};
+
+// Items of a selection widget, accessed lazily so that large lists don't need to be copied
+struct ItemLabels {
+	virtual ~ItemLabels() = default;
+	virtual std::size_t size() const = 0;
+	virtual std::string label(std::size_t index) const = 0;
+};
+
+template <typename T>
+struct ItemSource : public ItemLabels {
+	virtual T at(std::size_t index) const = 0;
+};
+
+template <typename T>
+class VectorSource : public ItemSource<T> {
+	std::shared_ptr<const std::vector<T>> _items;
+	std::function<std::string(const T&)> _toLabel;
+public:
+	VectorSource(const std::shared_ptr<const std::vector<T>>& items, const std::function<std::string(const T&)>& toLabel = nullptr)
+			: _items(items), _toLabel(toLabel) {
+		if constexpr(!std::is_same_v<T, std::string> && !std::is_arithmetic_v<T>)
+			if (!_toLabel)
+				throw DuGuiError("Items that are neither strings nor numbers need a function to get their labels");
+	}
+
+	std::size_t size() const override {
+		return _items->size();
+	}
+	std::string label(std::size_t index) const override {
+		if (_toLabel)
+			return _toLabel((*_items)[index]);
+		if constexpr(std::is_same_v<T, std::string>)
+			return (*_items)[index];
+		else if constexpr(std::is_arithmetic_v<T>)
+			return std::to_string((*_items)[index]);
+		else
+			return std::string();
+	}
+	T at(std::size_t index) const override {
+		return (*_items)[index];
+	}
+};
+
+// Items sorted by their ASCII case folded labels, all items starting with a prefix form a contiguous range
+class PrefixIndex {
+	std::shared_ptr<const ItemLabels> _items;
+	std::vector<std::uint32_t> _sorted;
+
+	// Compares only the first query.size() characters of the label
+	static int comparePrefix(const std::string& label, const std::string& query) {
+		for (std::size_t i = 0; i < query.size(); i++) {
+			if (i == label.size())
+				return -1;
+			char folded = char(std::tolower((unsigned char)label[i]));
+			if (folded != query[i])
+				return (unsigned char)folded < (unsigned char)query[i] ? -1 : 1;
+		}
+		return 0;
+	}
+
+public:
+	// Sorts all labels, it's meant to be called in a background task for large lists
+	PrefixIndex(const std::shared_ptr<const ItemLabels>& items) : _items(items) {
+		if (_items->size() > std::numeric_limits<std::uint32_t>::max())
+			throw DuGuiError("Too many items to index");
+		std::vector<std::string> keys(_items->size());
+		for (std::size_t i = 0; i < keys.size(); i++)
+			keys[i] = fold(_items->label(i));
+		_sorted.resize(keys.size());
+		std::iota(_sorted.begin(), _sorted.end(), 0);
+		std::sort(_sorted.begin(), _sorted.end(), [&keys] (std::uint32_t first, std::uint32_t second) {
+			int compared = keys[first].compare(keys[second]);
+			return compared < 0 || (compared == 0 && first < second);
+		});
+	}
+
+	static std::string fold(std::string text) {
+		for (char& it : text)
+			it = char(std::tolower((unsigned char)it));
+		return text;
+	}
+
+	const std::shared_ptr<const ItemLabels>& items() const {
+		return _items;
+	}
+	std::size_t size() const {
+		return _sorted.size();
+	}
+	std::size_t item(std::size_t position) const {
+		return _sorted[position];
+	}
+
+	// Positions between begin and end whose labels start with the folded query, found by binary search
+	std::pair<std::size_t, std::size_t> find(const std::string& folded, std::size_t begin, std::size_t end) const {
+		auto lower = std::partition_point(_sorted.begin() + begin, _sorted.begin() + end, [&] (std::uint32_t it) {
+			return comparePrefix(_items->label(it), folded) < 0;
+		});
+		auto upper = std::partition_point(lower, _sorted.begin() + end, [&] (std::uint32_t it) {
+			return comparePrefix(_items->label(it), folded) == 0;
+		});
+		return { lower - _sorted.begin(), upper - _sorted.begin() };
+	}
+};
+
+// Incremental search, a query extending the previous one only searches among the previous matches
+class PrefixSearch {
+	std::shared_ptr<const PrefixIndex> _index;
+	std::string _query;
+	std::size_t _begin = 0;
+	std::size_t _end = 0;
+
+public:
+	PrefixSearch(const std::shared_ptr<const PrefixIndex>& index = nullptr) {
+		setIndex(index);
+	}
+
+	void setIndex(const std::shared_ptr<const PrefixIndex>& index) {
+		_index = index;
+		_query.clear();
+		_begin = 0;
+		_end = _index ? _index->size() : 0;
+	}
+	const std::shared_ptr<const PrefixIndex>& index() const {
+		return _index;
+	}
+
+	void find(const std::string& query) {
+		if (!_index)
+			return;
+		std::string folded = PrefixIndex::fold(query);
+		if (folded.size() < _query.size() || folded.compare(0, _query.size(), _query) != 0) {
+			_begin = 0;
+			_end = _index->size();
+		}
+		std::tie(_begin, _end) = _index->find(folded, _begin, _end);
+		_query = std::move(folded);
+	}
+
+	std::size_t matches() const {
+		return _end - _begin;
+	}
+	std::size_t item(std::size_t match) const {
+		return _index->item(_begin + match);
+	}
+	std::string label(std::size_t match) const {
+		return _index->items()->label(item(match));
+	}
+};
 
 struct Backend {
 	struct StartupProperties {
@@ -38,12 +334,19 @@ struct Backend {
 		std::function<void(long long int)> intReaction;
 		std::function<void(double)> doubleReaction;
 		std::function<void()> reaction;
+		std::function<void(TaskContext&)> asyncReaction;
+		std::function<void(double)> asyncProgress;
+		bool disableWhileRunning = false;
 		std::string stringValue;
 		long long int intValue = 0;
 		double doubleValue = 0;
 		bool border = false;
 		bool windowed = false;
 		std::string placeholderText;
+		std::size_t maxLines = 10000;
+		std::size_t maxBytes = 0;
+		std::shared_ptr<LogBuffer> logBuffer;
+		std::shared_ptr<const PrefixIndex> itemIndex;
 		std::vector<std::shared_ptr<Widget>> childrenShared;
 		std::vector<Widget*> childrenStatic;
 		template <typename T>
@@ -53,8 +356,11 @@ struct Backend {
 			for (auto& it : childrenStatic)
 				operation(it);
 		}
+		LiveCount<StartupProperties, &LiveObjects::properties> live;
 	};
 
+	virtual ~Backend() = default;
+
 	virtual void create(StartupProperties* properties) = 0;
 	virtual void setTitle(const std::string& title) = 0;
 	virtual void addValueChangedReacion(const std::function<void(const std::string&)>& reaction) = 0;
@@ -64,10 +370,353 @@ struct Backend {
 	virtual void setValue(const std::string& value) = 0;
 	virtual void setValue(long long int value) = 0;
 	virtual void setValue(double value) = 0;
+	virtual void setItems(const std::shared_ptr<const PrefixIndex>& items) = 0;
+	virtual void setEnabled(bool enabled) = 0;
+	virtual void batchUpdates(bool batching) = 0;
+	virtual void runInGuiThread(const std::function<void()>& action) = 0;
 	virtual void close() = 0;
 	virtual std::shared_ptr<Backend> createAnotherElement() = 0;
 };
 
+// Background tasks
+
+class ThreadPool {
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+	std::vector<std::unique_ptr<Queue>> _queues;
+	std::vector<std::thread> _threads;
+	std::mutex _sleepMutex;
+	std::condition_variable _wake;
+	std::atomic<std::size_t> _pending = 0;
+	std::atomic<std::size_t> _nextQueue = 0;
+	std::atomic<bool> _stopping = false;
+
+	inline static thread_local ThreadPool* _currentPool = nullptr;
+	inline static thread_local std::size_t _currentQueue = 0;
+
+	// Own tasks are taken from the back, others' tasks are stolen from the front
+	bool take(std::size_t index, std::function<void()>& task) {
+		for (std::size_t i = 0; i < _queues.size(); i++) {
+			Queue& queue = *_queues[(index + i) % _queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty())
+				continue;
+			if (i == 0) {
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+			} else {
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+			}
+			_pending--;
+			return true;
+		}
+		return false;
+	}
+
+	void work(std::size_t index) {
+		_currentPool = this;
+		_currentQueue = index;
+		while (!_stopping) {
+			std::function<void()> task;
+			if (take(index, task)) {
+				task();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(_sleepMutex);
+			_wake.wait(lock, [this] { return _stopping || _pending > 0; });
+		}
+	}
+
+public:
+	ThreadPool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+		for (std::size_t i = 0; i < threads; i++)
+			_queues.push_back(std::make_unique<Queue>());
+		for (std::size_t i = 0; i < threads; i++)
+			_threads.emplace_back([this, i] { work(i); });
+	}
+	// Tasks that haven't started yet are dropped, the running ones are waited for
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_stopping = true;
+		}
+		_wake.notify_all();
+		for (auto& it : _threads)
+			it.join();
+	}
+
+	void submit(std::function<void()> task) {
+		std::size_t index = (_currentPool == this) ? _currentQueue : _nextQueue++ % _queues.size();
+		_pending++;
+		{
+			std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+			_queues[index]->tasks.push_back(std::move(task));
+		}
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_wake.notify_one();
+	}
+
+	std::size_t size() const {
+		return _threads.size();
+	}
+	// Set when the pool is being destroyed, usually at exit when the GUI is already gone
+	bool stopping() const {
+		return _stopping;
+	}
+
+	static ThreadPool& global() {
+		static ThreadPool pool;
+		return pool;
+	}
+};
+
+// Everything a task shares with the GUI thread, the callbacks are only touched from the GUI thread
+struct TaskState {
+	std::shared_ptr<Backend> gui;
+	std::atomic<bool> cancelled = false;
+	std::atomic<bool> finished = false;
+	std::atomic<double> progress = 0;
+	std::atomic<bool> progressPosted = false;
+	std::exception_ptr error;
+	std::function<void(double)> onProgress;
+	std::function<void(std::exception_ptr)> onError;
+	std::function<void()> onFinished;
+
+	// Exceptions can't be thrown through the event loop of the GUI
+	static void reportError(std::exception_ptr error) {
+		try {
+			std::rethrow_exception(error);
+		} catch (std::exception& exception) {
+			std::cerr << "Background task failed: " << exception.what() << std::endl;
+		} catch (...) {
+			std::cerr << "Background task failed with an unknown exception" << std::endl;
+		}
+	}
+};
+
+class TaskContext {
+	std::shared_ptr<TaskState> _state;
+public:
+	TaskContext(const std::shared_ptr<TaskState>& state) : _state(state) {
+	}
+
+	bool cancelled() const {
+		return _state->cancelled;
+	}
+
+	// Can be called as often as needed, the GUI only gets the latest value once per pass of its event loop
+	void progress(double fraction) {
+		_state->progress = fraction;
+		if (ThreadPool::global().stopping() || _state->progressPosted.exchange(true))
+			return;
+		_state->gui->runInGuiThread([state = _state] {
+			state->progressPosted = false;
+			if (state->onProgress && !state->cancelled)
+				state->onProgress(state->progress);
+		});
+	}
+};
+
+class Progress;
+
+template <typename Result>
+class Task {
+	struct NoResult {};
+	using Stored = std::conditional_t<std::is_void_v<Result>, NoResult, Result>;
+public:
+	using Callback = std::conditional_t<std::is_void_v<Result>, std::function<void()>, std::function<void(const Stored&)>>;
+
+	struct State : TaskState {
+		std::optional<Stored> result;
+		Callback onDone;
+
+		// Nothing is called once the task is cancelled, the objects the callbacks refer to may be gone
+		void complete() {
+			if (cancelled)
+				return;
+			if (!error && onDone) {
+				if constexpr(std::is_void_v<Result>)
+					onDone();
+				else
+					onDone(*result);
+			}
+			if (onFinished)
+				onFinished();
+			if (error) {
+				if (onError)
+					onError(error);
+				else
+					reportError(error);
+			}
+		}
+	};
+
+private:
+	std::shared_ptr<State> _state;
+
+public:
+	Task() = default;
+	Task(const std::shared_ptr<State>& state) : _state(state) {
+	}
+
+	// Callbacks run in the GUI thread and can be set right after the task was started, an empty task ignores them
+	Task& then(const Callback& onDone) {
+		if (_state)
+			_state->onDone = onDone;
+		return *this;
+	}
+	Task& onProgress(const std::function<void(double)>& reaction) {
+		if (_state)
+			_state->onProgress = reaction;
+		return *this;
+	}
+	Task& showProgress(Progress& shown);
+	Task& onError(const std::function<void(std::exception_ptr)>& reaction) {
+		if (_state)
+			_state->onError = reaction;
+		return *this;
+	}
+	Task& onFinished(const std::function<void()>& reaction) {
+		if (_state)
+			_state->onFinished = reaction;
+		return *this;
+	}
+
+	void cancel() {
+		if (_state)
+			_state->cancelled = true;
+	}
+	bool running() const {
+		return _state && !_state->finished;
+	}
+	bool cancelled() const {
+		return _state && _state->cancelled;
+	}
+};
+
+// Undo history of a window, each step keeps only the values of the inputs that changed in it
+class History {
+public:
+	using Value = std::variant<std::string, long long int, double>;
+
+private:
+	struct Change {
+		Widget* widget;
+		void (*restore)(Widget*, const Value&);
+		Value before;
+		Value after;
+	};
+	struct Step {
+		std::vector<Change> changes;
+		std::size_t bytes = 0;
+	};
+
+	Widget* _root;
+	std::deque<Step> _steps;
+	std::size_t _done = 0;
+	std::size_t _bytes = 0;
+	std::size_t _maxBytes;
+	int _grouping = 0;
+	bool _groupStarted = false;
+	bool _restoring = false;
+
+	static std::size_t size(const Value& value) {
+		if (auto text = std::get_if<std::string>(&value))
+			return text->capacity();
+		return 0;
+	}
+
+	// The step an open group is still filling is kept, or the group's later changes would start another one
+	void trim() {
+		while (_bytes > _maxBytes && _done > (_grouping > 0 ? 1 : 0)) {
+			_bytes -= _steps.front().bytes;
+			_steps.pop_front();
+			_done--;
+		}
+	}
+
+	void restore(const Step& step, bool forward);
+
+public:
+	History(Widget* root, std::size_t maxBytes) : _root(root), _maxBytes(maxBytes) {
+	}
+
+	// Changes done while a group exists are undone together
+	class Group {
+		History* _history;
+	public:
+		Group(History* history) : _history(history) {
+			if (_history && !_history->_grouping++)
+				_history->_groupStarted = false;
+		}
+		Group(const Group&) = delete;
+		~Group() {
+			if (_history)
+				_history->_grouping--;
+		}
+	};
+
+	void record(Widget* widget, void (*restore)(Widget*, const Value&), Value before, Value after) {
+		if (_restoring || before == after)
+			return;
+		while (_steps.size() > _done) {
+			_bytes -= _steps.back().bytes;
+			_steps.pop_back();
+		}
+		if (!_grouping || !_groupStarted || _steps.empty()) {
+			_steps.emplace_back();
+			_done++;
+			_groupStarted = true;
+		}
+		Step& step = _steps.back();
+		std::size_t bytes = sizeof(Change) + size(before) + size(after);
+		step.changes.push_back({ widget, restore, std::move(before), std::move(after) });
+		step.bytes += bytes;
+		_bytes += bytes;
+		trim();
+	}
+
+	bool canUndo() const {
+		return _done > 0;
+	}
+	bool canRedo() const {
+		return _done < _steps.size();
+	}
+	bool undo() {
+		if (!canUndo())
+			return false;
+		_done--;
+		restore(_steps[_done], false);
+		// Changes after this belong to a new step, even inside a group
+		_groupStarted = false;
+		return true;
+	}
+	bool redo() {
+		if (!canRedo())
+			return false;
+		restore(_steps[_done], true);
+		_done++;
+		_groupStarted = false;
+		return true;
+	}
+
+	void limit(std::size_t maxBytes) {
+		_maxBytes = maxBytes;
+		trim();
+	}
+	std::size_t bytes() const {
+		return _bytes;
+	}
+	void clear() {
+		_steps.clear();
+		_done = 0;
+		_bytes = 0;
+	}
+};
+
 // Setting properties
 
 struct PropertyGroup {
@@ -108,6 +757,23 @@ struct PropertyGroup {
 		properties->doubleValue = value;
 		return *this;
 	}
+	PropertyGroup maxLines(std::size_t lines) {
+		properties->maxLines = lines;
+		return *this;
+	}
+	PropertyGroup maxBytes(std::size_t bytes) {
+		properties->maxBytes = bytes;
+		return *this;
+	}
+	PropertyGroup asyncReaction(const std::function<void(TaskContext&)>& work) {
+		properties->asyncReaction = work;
+		return *this;
+	}
+	PropertyGroup disableWhileRunning() {
+		properties->disableWhileRunning = true;
+		return *this;
+	}
+	PropertyGroup showProgress(Progress& shown);
 	PropertyGroup noBorder() {
 		properties->border = false;
 		return *this;
@@ -156,6 +822,9 @@ protected:
 		properties()->title = title;
 	}
 	std::shared_ptr<Backend> _backend;
+	std::shared_ptr<History> _history;
+	std::vector<std::weak_ptr<TaskState>> _tasks; // Started by any widget of the window, kept by the window's root
+	LiveCount<Widget, &LiveObjects::widgets> _live;
 public:
 	Backend::StartupProperties* properties() {
 		return _properties.properties.get();
@@ -167,6 +836,23 @@ public:
 		return _properties.parent;
 	}
 
+	// Starts recording changes of the inputs in this window, the oldest steps are forgotten above the limit
+	void enableHistory(std::size_t maxBytes = 16 << 20) {
+		Widget* root = this;
+		while (root->parent())
+			root = root->parent();
+		if (!root->_history)
+			root->_history = std::make_shared<History>(root, maxBytes);
+		else
+			root->_history->limit(maxBytes);
+	}
+	History* history() {
+		Widget* root = this;
+		while (root->parent())
+			root = root->parent();
+		return root->_history.get();
+	}
+
 	// pseudo widget
 	struct Title {
 		Title(const PropertyGroup& properties) {
@@ -178,6 +864,20 @@ public:
 		properties()->windowed = true;
 		propagateBackends(parentBackend);
 		_backend->create(properties());
+		releaseBackends();
+	}
+
+	// Called when the window is closed, cancels its tasks, drops the backends and the reactions that were waiting to be set up
+	void releaseBackends() {
+		for (auto& it : _tasks)
+			if (auto task = it.lock())
+				task->cancelled = true;
+		_tasks.clear();
+		if (_properties.properties)
+			_properties.properties->foreachChildren([] (Widget* it) {
+				it->releaseBackends();
+			});
+		_backend.reset();
 		_properties.properties.reset();
 	}
 
@@ -191,10 +891,50 @@ public:
 
 	void close() {
 		if (!_backend)
-			throw DuGuiError("Closing a window before it's open");
+			throw DuGuiError("Closing a window that isn't open");
 		_backend->close();
 	}
 
+	// Runs work(TaskContext&) in the thread pool, callbacks of the returned task run in the GUI thread
+	// The task is cancelled when the window closes, but work that is already running isn't stopped
+	template <typename Work>
+	Task<std::invoke_result_t<Work, TaskContext&>> runAsync(Work work) {
+		using Result = std::invoke_result_t<Work, TaskContext&>;
+		if (!_backend)
+			throw DuGuiError("Running a task before the window is open");
+		auto state = std::make_shared<typename Task<Result>::State>();
+		state->gui = _backend;
+		Widget* root = this;
+		while (root->parent())
+			root = root->parent();
+		root->_tasks.erase(std::remove_if(root->_tasks.begin(), root->_tasks.end(), [] (const std::weak_ptr<TaskState>& it) {
+			auto task = it.lock();
+			return !task || task->finished;
+		}), root->_tasks.end());
+		root->_tasks.push_back(state);
+		ThreadPool::global().submit([state, work = std::move(work)] () mutable {
+			TaskContext context(state);
+			try {
+				if (!state->cancelled) {
+					if constexpr(std::is_void_v<Result>) {
+						work(context);
+						state->result.emplace();
+					} else
+						state->result.emplace(work(context));
+				}
+			} catch (...) {
+				state->error = std::current_exception();
+			}
+			state->finished = true;
+			if (ThreadPool::global().stopping())
+				return;
+			state->gui->runInGuiThread([state] {
+				state->complete();
+			});
+		});
+		return Task<Result>(state);
+	}
+
 	Widget(const PropertyGroup& props) : _properties(props) {
 		_properties.parent->properties()->childrenStatic.push_back(this);
 	}
@@ -221,10 +961,26 @@ PropertyGroup PropertyGroup::reaction(void(Class::*method)()) {
 	return *this;
 }
 
+inline void History::restore(const Step& step, bool forward) {
+	std::shared_ptr<Backend> backend = _root->backend();
+	if (backend)
+		backend->batchUpdates(true);
+	_restoring = true;
+	if (forward)
+		for (auto it = step.changes.begin(); it != step.changes.end(); ++it)
+			it->restore(it->widget, it->after);
+	else
+		for (auto it = step.changes.rbegin(); it != step.changes.rend(); ++it)
+			it->restore(it->widget, it->before);
+	_restoring = false;
+	if (backend)
+		backend->batchUpdates(false);
+}
+
 class Container : public Widget {
-	bool _border = false;
 	void setBorder(bool border) {
-		_border = border;
+		if (properties())
+			properties()->border = border;
 	}
 
 	PropertyGroup makeChildProperties() {
@@ -304,17 +1060,44 @@ struct Formulaire : public Container {
 	}
 };
 
+template <typename T, typename SFINAE>
+class InputDerived;
+
 template <typename T>
 class InputBase : public Widget {
 protected:
 	T _contents;
 
+	static History::Value historyValue(const T& value) {
+		if constexpr(std::is_integral_v<T>)
+			return (long long int)(value);
+		else if constexpr(std::is_floating_point_v<T>)
+			return double(value);
+		else
+			return value;
+	}
+	// Through the derived class, so that the value shown when the window opens is updated too
+	static void restore(Widget* widget, const History::Value& value) {
+		if constexpr(std::is_integral_v<T>)
+			static_cast<InputDerived<T, void>*>(widget)->operator=(T(std::get<long long int>(value)));
+		else if constexpr(std::is_floating_point_v<T>)
+			static_cast<InputBase<T>*>(widget)->InputBase<T>::operator=(T(std::get<double>(value)));
+		else
+			static_cast<InputDerived<T, void>*>(widget)->operator=(std::get<T>(value));
+	}
+	void changeContents(const T& value) {
+		if (History* recording = history())
+			recording->record(this, &restore, historyValue(_contents), historyValue(value));
+		_contents = value;
+	}
+
 public:
 	InputBase(const PropertyGroup& props) : Widget(props) {
 	}
 
 	void set(const T& newValue) {
-		_backend->setValue(newValue);
+		if (_backend)
+			_backend->setValue(newValue);
 	}
 
 	const T& operator*() const {
@@ -324,7 +1107,7 @@ public:
 		return *_contents;
 	}
 	T& operator=(const T& assigned) {
-		_contents = assigned;
+		changeContents(assigned);
 		if (_backend) {
 			if constexpr(std::is_integral_v<T>)
 				_backend->setValue((long long int)(assigned));
@@ -350,7 +1133,7 @@ public:
 	InputDerived(const PropertyGroup& properties) : InputBase(properties) {
 		Widget::properties()->widgetType = WidgetType::LineEdit;
 		properties.properties->stringReaction = [this] (const std::string& newText) {
-			_contents = newText;
+			changeContents(newText);
 		};
 	}
 	std::string& operator=(const std::string& assigned) {
@@ -362,14 +1145,14 @@ public:
 	InputDerived() {
 		Widget::properties()->widgetType = WidgetType::LineEdit;
 		properties()->stringReaction = [this] (const std::string& newText) {
-			_contents = newText;
+			changeContents(newText);
 		};
 	}
 
 	void reaction(const std::function<void(const std::string&)> reactionSet) {
 		if (_backend)
 			_backend->addValueChangedReacion(reactionSet);
-		else
+		else if (properties())
 			_properties.reactionToChange(reactionSet);
 	}
 };
@@ -380,7 +1163,7 @@ public:
 	InputDerived(const PropertyGroup& props) : InputBase<T>(props) {
 		Widget::properties()->widgetType = WidgetType::NumberEdit;
 		InputBase<T>::properties()->intReaction = [this] (long long int newNumber) {
-			InputBase<T>::_contents = newNumber;
+			InputBase<T>::changeContents(newNumber);
 		};
 		InputBase<T>::_contents = 0;
 	}
@@ -392,7 +1175,7 @@ public:
 	InputDerived() {
 		Widget::properties()->widgetType = WidgetType::NumberEdit;
 		InputBase<T>::properties()->intReaction = [this] (long long int newNumber) {
-			InputBase<T>::_contents = newNumber;
+			InputBase<T>::changeContents(newNumber);
 		};
 	}
 
@@ -405,7 +1188,7 @@ public:
 				InputBase<T>::_backend->addReaction([set = reactionSet] (Changed changed) {
 					set(changed);
 				});
-		} else
+		} else if (InputBase<T>::properties())
 			InputBase<T>::_properties.reactionToChange(reactionSet);
 	}
 };
@@ -414,15 +1197,50 @@ template <typename T>
 using Input = InputDerived<T, void>;
 
 class Button : public Widget {
+	Task<void> _task;
+	bool _disableWhileRunning = false;
+
+	void setupAsync() {
+		if (!properties()->asyncReaction)
+			return;
+		_disableWhileRunning = properties()->disableWhileRunning;
+		_properties.reaction([this, work = properties()->asyncReaction, progress = properties()->asyncProgress] {
+			if (_disableWhileRunning)
+				_backend->setEnabled(false);
+			_task.cancel();
+			_task = runAsync(work);
+			_task.onProgress(progress);
+			if (_disableWhileRunning)
+				_task.onFinished([backend = std::weak_ptr<Backend>(_backend)] {
+					if (auto alive = backend.lock())
+						alive->setEnabled(true);
+				});
+		});
+	}
 public:
 	Button(const PropertyGroup& propertiesSet) : Widget(propertiesSet) {
 		properties()->widgetType = WidgetType::Button;
+		setupAsync();
+	}
+	~Button() {
+		_task.cancel();
+	}
+
+	// The task started by the last click if the button has an asynchronous reaction, another click cancels it
+	Task<void>& task() {
+		return _task;
+	}
+	// Cancelled tasks don't call back, so this also enables the button again
+	void cancel() {
+		_task.cancel();
+		if (_disableWhileRunning && _backend)
+			_backend->setEnabled(true);
 	}
 
 	void operator=(const std::function<void()> reactionSet) {
 		if (_backend)
 			_backend->addReaction(reactionSet);
-		else
+		else if (properties())
 			_properties.reaction(reactionSet);
 	}
 	Button() {
@@ -430,5 +1248,148 @@ public:
 	}
 };
 
+// Append-only view of the last lines written into it, append() can be called from any thread
+class LogView : public Widget {
+	std::shared_ptr<LogBuffer> _buffer;
+
+	void setup() {
+		properties()->widgetType = WidgetType::LogView;
+		_buffer = std::make_shared<LogBuffer>(properties()->maxLines, properties()->maxBytes);
+		properties()->logBuffer = _buffer;
+	}
+public:
+	LogView(const PropertyGroup& propertiesSet) : Widget(propertiesSet) {
+		setup();
+	}
+	LogView() {
+		setup();
+	}
+
+	void append(const std::string& text) {
+		_buffer->append(text);
+	}
+	void clear() {
+		_buffer->clear();
+	}
+	void limit(std::size_t maxLines, std::size_t maxBytes = 0) {
+		_buffer->limit(maxLines, maxBytes);
+	}
+	const std::shared_ptr<LogBuffer>& buffer() const {
+		return _buffer;
+	}
+};
+
+class Progress : public Widget {
+public:
+	Progress(const PropertyGroup& propertiesSet) : Widget(propertiesSet) {
+		properties()->widgetType = WidgetType::Progress;
+	}
+	Progress() {
+		properties()->widgetType = WidgetType::Progress;
+	}
+
+	// Fraction between 0 and 1
+	void operator=(double fraction) {
+		if (_backend)
+			_backend->setValue(fraction);
+		else if (properties())
+			properties()->doubleValue = fraction;
+	}
+};
+
+// Selects one of possibly very many items, typing into it filters them by prefix
+template <typename T>
+class ComboBox : public Widget {
+	std::shared_ptr<const ItemSource<T>> _items;
+	long long int _selected = -1;
+	Task<std::shared_ptr<const PrefixIndex>> _indexing;
+
+	void setup() {
+		properties()->widgetType = WidgetType::ComboBox;
+		properties()->intValue = -1;
+		properties()->intReaction = [this] (long long int selected) {
+			_selected = selected;
+		};
+	}
+public:
+	ComboBox(const PropertyGroup& propertiesSet) : Widget(propertiesSet) {
+		setup();
+	}
+	ComboBox() {
+		setup();
+	}
+	~ComboBox() {
+		_indexing.cancel();
+	}
+
+	// If the window is open, the items are indexed in background and replace the old ones when done
+	// Before it's open, they're indexed right away in the calling thread, about a second per million items
+	void setItems(const std::shared_ptr<const ItemSource<T>>& items) {
+		if (!_backend) {
+			_items = items;
+			_selected = -1;
+			if (properties())
+				properties()->itemIndex = std::make_shared<PrefixIndex>(items);
+			return;
+		}
+		_indexing.cancel();
+		_indexing = runAsync([items] (TaskContext&) -> std::shared_ptr<const PrefixIndex> {
+			return std::make_shared<PrefixIndex>(items);
+		});
+		_indexing.then([this, items] (const std::shared_ptr<const PrefixIndex>& index) {
+			_items = items;
+			_selected = -1;
+			if (_backend)
+				_backend->setItems(index);
+		});
+	}
+	void setItems(std::vector<T> items, const std::function<std::string(const T&)>& toLabel = nullptr) {
+		setItems(std::make_shared<VectorSource<T>>(std::make_shared<const std::vector<T>>(std::move(items)), toLabel));
+	}
+
+	long long int selectedIndex() const {
+		return _selected;
+	}
+	std::optional<T> selected() const {
+		if (_selected < 0 || !_items)
+			return std::nullopt;
+		return _items->at(_selected);
+	}
+	// An index that isn't among the items clears the selection
+	void select(long long int index) {
+		if (index < 0 || !_items || std::size_t(index) >= _items->size())
+			index = -1;
+		_selected = index;
+		if (_backend)
+			_backend->setValue(index);
+		else if (properties())
+			properties()->intValue = index;
+	}
+
+	void reaction(const std::function<void(const T&)>& reactionSet) {
+		std::function<void(long long int)> reactionToIndex = [this, reactionSet] (long long int selected) {
+			reactionSet(_items->at(selected));
+		};
+		if (_backend)
+			_backend->addValueChangedReacion(reactionToIndex);
+		else if (properties())
+			_properties.reactionToChangeGeneric(properties()->intReaction, reactionToIndex);
+	}
+};
+
+inline PropertyGroup PropertyGroup::showProgress(Progress& shown) {
+	properties->asyncProgress = [&shown] (double fraction) {
+		shown = fraction;
+	};
+	return *this;
+}
+
+template <typename Result>
+Task<Result>& Task<Result>::showProgress(Progress& shown) {
+	return onProgress([&shown] (double fraction) {
+		shown = fraction;
+	});
+}
+
 } // namespace DuGUI
 #endif // DUGUI
@@ -8,8 +8,20 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QLabel>
+#include <QAbstractScrollArea>
+#include <QScrollBar>
+#include <QPainter>
+#include <QTimer>
+#include <QProgressBar>
+#include <QCoreApplication>
+#include <QAbstractListModel>
+#include <QCompleter>
+#include <QListView>
+#include <QPointer>
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 
 using namespace DuGUI;
 
@@ -17,29 +29,338 @@ class DuGUI::BackendQtWindow : public QDialog {
 
 };
 
+namespace {
+
+// Every native widget is counted in LiveObjects until Qt destroys it
+template <typename T, typename... Args>
+T* makeNative(Args&&... args) {
+	T* made = new T(std::forward<Args>(args)...);
+	LiveObjects::get().nativeWidgets++;
+	QObject::connect(made, &QObject::destroyed, [] () {
+		LiveObjects::get().nativeWidgets--;
+	});
+	return made;
+}
+
+} // namespace
+
+// Paints only the visible lines, new lines are picked up once per frame
+class DuGUI::BackendQtLogView : public QAbstractScrollArea {
+	std::shared_ptr<LogBuffer> _buffer;
+	QTimer _frame;
+	unsigned long long _changes = 0;
+	unsigned long long _dropped = 0;
+
+	int visibleLines() const {
+		return std::max(1, viewport()->height() / fontMetrics().lineSpacing());
+	}
+
+	void updateRange() {
+		int visible = visibleLines();
+		verticalScrollBar()->setPageStep(visible);
+		verticalScrollBar()->setRange(0, std::max(0, int(_buffer->size()) - visible));
+	}
+
+	void flush() {
+		unsigned long long changes = _buffer->changes();
+		if (changes == _changes)
+			return;
+		unsigned long long dropped = _buffer->dropped();
+		QScrollBar* bar = verticalScrollBar();
+		bool following = (bar->value() == bar->maximum());
+		int position = bar->value() - int(dropped - _dropped);
+		_changes = changes;
+		_dropped = dropped;
+		updateRange();
+		bar->setValue(following ? bar->maximum() : std::max(0, position));
+		viewport()->update();
+	}
+
+public:
+	BackendQtLogView(const std::shared_ptr<LogBuffer>& buffer) : _buffer(buffer), _frame(this) {
+		QObject::connect(&_frame, &QTimer::timeout, this, [this] () {
+			flush();
+		});
+		_frame.start(16);
+	}
+
+protected:
+	void paintEvent(QPaintEvent*) override {
+		QPainter painter(viewport());
+		int spacing = fontMetrics().lineSpacing();
+		int y = fontMetrics().ascent();
+		for (const std::string& line : _buffer->lines(verticalScrollBar()->value(), visibleLines() + 1)) {
+			painter.drawText(2, y, QString::fromStdString(line));
+			y += spacing;
+		}
+	}
+	void resizeEvent(QResizeEvent* event) override {
+		QAbstractScrollArea::resizeEvent(event);
+		updateRange();
+	}
+	void scrollContentsBy(int, int) override {
+		viewport()->update();
+	}
+};
+
+// Only the current matches, the popup asks only for the rows it shows
+class DuGUI::BackendQtMatches : public QAbstractListModel {
+public:
+	PrefixSearch search;
+	std::vector<std::function<void(long long int)>> reactions;
+
+	using QAbstractListModel::QAbstractListModel;
+
+	int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+		return parent.isValid() ? 0 : int(search.matches());
+	}
+	QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+		if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+			return QVariant();
+		return QString::fromStdString(search.label(std::size_t(index.row())));
+	}
+
+	void select(QLineEdit* edit, std::size_t item) {
+		edit->setText(QString::fromStdString(search.index()->items()->label(item)));
+		for (auto& it : reactions)
+			it(item);
+	}
+
+	void find(const std::string& query) {
+		beginResetModel();
+		search.find(query);
+		endResetModel();
+	}
+	void setIndex(const std::shared_ptr<const PrefixIndex>& index) {
+		beginResetModel();
+		search.setIndex(index);
+		endResetModel();
+	}
+};
+
+struct DuGUI::BackendQtSession : public std::enable_shared_from_this<BackendQtSession> {
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<BackendQt*> widgets;
+
+	InteractionTrace* recording = nullptr;
+	bool recordingStarted = false;
+	Clock::time_point recordingStart;
+
+	const InteractionTrace* replaying = nullptr;
+	BackendQt::ReplaySpeed speed = BackendQt::ReplaySpeed::AsFastAsPossible;
+	ReplayReport* report = nullptr;
+	bool replayStarted = false;
+	bool replayFinished = false;
+	bool scheduled = false;
+	std::size_t next = 0;
+	Clock::time_point replayStart;
+	std::vector<std::vector<double>> latencies;
+	std::vector<QPointer<QDialog>> windows; // Open windows, the innermost last
+
+	// The event whose reaction is running, a reaction that opens a dialog is measured only until the dialog opens
+	struct Dispatch {
+		std::uint32_t widget;
+		Clock::time_point started;
+		bool measured = false;
+	};
+	Dispatch* dispatching = nullptr;
+
+	static double microseconds(Clock::duration duration) {
+		return std::chrono::duration<double, std::micro>(duration).count();
+	}
+
+	void record(std::uint32_t widget, InteractionTrace::Kind kind, long long int number, std::string text) {
+		recording->events.push_back({ std::uint64_t(microseconds(Clock::now() - recordingStart)), widget, kind, number, std::move(text) });
+	}
+
+	void windowOpened(QDialog* window) {
+		windows.push_back(window);
+		if (recording && !recordingStarted) {
+			recordingStarted = true;
+			recordingStart = Clock::now();
+		}
+		if (!replaying || replayFinished)
+			return;
+		if (!replayStarted) {
+			replayStarted = true;
+			replayStart = Clock::now();
+		}
+		if (dispatching)
+			measure(*dispatching);
+		schedule();
+	}
+
+	void windowClosed(std::uint32_t window) {
+		windows.pop_back();
+		if (recording)
+			record(window, InteractionTrace::Kind::Closed, 0, std::string());
+		if (!replaying || !replayStarted || replayFinished)
+			return;
+		if (next < replaying->events.size() && replaying->events[next].kind == InteractionTrace::Kind::Closed
+				&& replaying->events[next].widget == window)
+			next++;
+		else if (windows.empty()) {
+			// Closed before the trace says so, what remains can't be replayed
+			finishReplay();
+			return;
+		}
+		if (next == replaying->events.size())
+			finish();
+		else
+			schedule();
+	}
+
+	void schedule() {
+		if (scheduled)
+			return;
+		scheduled = true;
+		int delay = 0;
+		if (speed == BackendQt::ReplaySpeed::Recorded && next < replaying->events.size())
+			delay = std::max(0, int((double(replaying->events[next].time) - microseconds(Clock::now() - replayStart)) / 1000));
+		// Going through the event loop lets the window repaint and deliver results of background tasks
+		QTimer::singleShot(delay, [session = shared_from_this()] {
+			session->scheduled = false;
+			session->replayNext();
+		});
+	}
+
+	void measure(Dispatch& dispatch) {
+		if (dispatch.measured)
+			return;
+		dispatch.measured = true;
+		if (latencies.size() <= dispatch.widget)
+			latencies.resize(dispatch.widget + 1);
+		latencies[dispatch.widget].push_back(microseconds(Clock::now() - dispatch.started));
+	}
+
+	void replayNext() {
+		// Continues when the next window opens or when the window the trace waits for closes
+		if (replayFinished || windows.empty())
+			return;
+		if (next == replaying->events.size()) {
+			finish();
+			return;
+		}
+		const InteractionTrace::Event& event = replaying->events[next];
+		if (event.kind == InteractionTrace::Kind::Closed) {
+			if (event.widget < widgets.size() && widgets[event.widget]->_windowed)
+				return;
+			next++; // Already closed
+		} else {
+			next++;
+			// The next event is scheduled first, so that it's delivered even if this one opens a dialog
+			if (next < replaying->events.size())
+				schedule();
+			if (event.widget < widgets.size()) {
+				Dispatch dispatch = { event.widget, Clock::now() };
+				Dispatch* outer = dispatching;
+				dispatching = &dispatch;
+				bool replayed = widgets[event.widget]->replay(event);
+				dispatching = outer;
+				if (replayed) {
+					measure(dispatch);
+					report->replayed++;
+				} else
+					report->missed++;
+			} else
+				report->missed++;
+		}
+		if (replayFinished)
+			return; // Finished by the dialog this event opened
+		if (next == replaying->events.size())
+			finish();
+		else
+			schedule();
+	}
+
+	// Closes the windows that are still open, the program continues as if the user closed them
+	void finish() {
+		finishReplay();
+		for (auto it = windows.rbegin(); it != windows.rend(); ++it)
+			if (*it)
+				(*it)->done(0);
+	}
+
+	void finishReplay() {
+		if (replayFinished)
+			return;
+		replayFinished = true;
+		for (std::size_t i = next; i < replaying->events.size(); i++)
+			if (replaying->events[i].kind != InteractionTrace::Kind::Closed)
+				report->missed++;
+		report->seconds = microseconds(Clock::now() - replayStart) / 1e6;
+		for (std::size_t i = 0; i < latencies.size(); i++) {
+			std::vector<double>& measured = latencies[i];
+			if (measured.empty())
+				continue;
+			std::sort(measured.begin(), measured.end());
+			auto percentile = [&measured] (double fraction) {
+				return measured[std::size_t(fraction * (measured.size() - 1))];
+			};
+			ReplayReport::Latencies summary;
+			summary.widget = std::uint32_t(i);
+			summary.count = measured.size();
+			for (double it : measured)
+				summary.mean += it;
+			summary.mean /= measured.size();
+			summary.median = percentile(0.5);
+			summary.p90 = percentile(0.9);
+			summary.p99 = percentile(0.99);
+			summary.max = measured.back();
+			report->reactions.push_back(summary);
+		}
+	}
+};
+
 void BackendQt::create(StartupProperties* properties) {
 	_type = properties->widgetType;
 	_windowed = properties->windowed;
+	if (_session) {
+		_id = std::uint32_t(_session->widgets.size());
+		_session->widgets.push_back(this);
+	}
 
 	auto makeContainer = [&] () -> QWidget* {
 		if (_windowed) {
-			_container.window = new BackendQtWindow;
+			_container.window = makeNative<BackendQtWindow>();
 			_container.window->setWindowTitle(QString::fromStdString(properties->title.empty() ?
 					"User Interface" : properties->title));
 			return _container.window;
 		} else {
-			_container.nonWindow = new QWidget;
+			_container.nonWindow = makeNative<QWidget>();
 			return _container.nonWindow;
 		}
 	};
 
+	// Connected before any reaction, so that events are recorded in the order they happened
+	auto recordIfNeeded = [&] () {
+		if (_session && _session->recording)
+			connectRecorder();
+	};
+
 	auto wrapIfNeeded = [&] (QWidget* wrapped) {
 		if (_auxiliary.description) return; // Done by parent
-		QWidget* container = makeContainer();
-		container->setLayout(new QHBoxLayout());
-		_auxiliary.description = new QLabel(QString::fromStdString(properties->title));
-		container->layout()->addWidget(_auxiliary.description);
-		container->layout()->addWidget(wrapped);
+		if (!_windowed && properties->title.empty()) return; // Nothing to add to the widget
+		_auxiliary.description = makeNative<QLabel>(QString::fromStdString(properties->title));
+		QBoxLayout* layout = new QHBoxLayout();
+		layout->addWidget(_auxiliary.description);
+		layout->addWidget(wrapped);
+		if (_windowed)
+			makeContainer()->setLayout(layout);
+		else {
+			_flat = true;
+			_container.layout = layout;
+		}
+	};
+
+	auto addChild = [] (auto* layout, BackendQt* child, auto... position) {
+		if (child->_flat)
+			layout->addLayout(child->_container.layout, position...);
+		else if (child->_container.dummy)
+			layout->addWidget(child->_container.nonWindow, position...);
+		else if (child->_widget.dummy)
+			layout->addWidget(child->_widget.dummy, position...);
 	};
 
 	switch (_type) {
@@ -53,48 +374,48 @@ void BackendQt::create(StartupProperties* properties) {
 		_auxiliary.children = new std::vector<std::shared_ptr<BackendQt>>();
 		int line = 0;
 		properties->foreachChildren([&] (Widget* it) {
-			QLabel* label = new QLabel(QString::fromStdString(it->properties()->title), making);
+			QLabel* label = makeNative<QLabel>(QString::fromStdString(it->properties()->title), making);
 			layout->addWidget(label, line, 0);
 			auto childBackend = std::dynamic_pointer_cast<BackendQt>(it->backend());
 			childBackend->_auxiliary.description = label;
 			it->backend()->create(it->properties());
 			_auxiliary.children->push_back(childBackend);
-			if (childBackend->_container.dummy)
-				layout->addWidget(childBackend->_container.nonWindow, line, 1);
-			else if (childBackend->_widget.dummy)
-				layout->addWidget(childBackend->_widget.dummy, line, 1);
+			addChild(layout, childBackend.get(), line, 1);
 			line++;
 		});
 		break;
 	} case WidgetType::HBox:
 	case WidgetType::VBox: {
-		QWidget* making = makeContainer();
-		QLayout* layout = nullptr;
+		QBoxLayout* layout = nullptr;
 		if (_type == WidgetType::VBox)
-			layout = new QVBoxLayout(making);
+			layout = new QVBoxLayout();
 		else
-			layout = new QHBoxLayout(making);
-		making->setLayout(layout);
+			layout = new QHBoxLayout();
+		if (_windowed || properties->border)
+			makeContainer()->setLayout(layout);
+		else {
+			_flat = true;
+			_container.layout = layout;
+		}
 
 		_auxiliary.children = new std::vector<std::shared_ptr<BackendQt>>();
 		properties->foreachChildren([&] (Widget* it) {
 			auto childBackend = std::dynamic_pointer_cast<BackendQt>(it->backend());
 			childBackend->create(it->properties());
 			_auxiliary.children->push_back(childBackend);
-			if (childBackend->_container.dummy)
-				layout->addWidget(childBackend->_container.nonWindow);
-			else if (childBackend->_widget.dummy)
-				layout->addWidget(childBackend->_widget.dummy);
+			addChild(layout, childBackend.get());
 		});
 		break;
 	} case WidgetType::LineEdit:
-		_widget.lineEdit = new QLineEdit();
+		_widget.lineEdit = makeNative<QLineEdit>();
+		recordIfNeeded();
 		wrapIfNeeded(_widget.lineEdit);
 		setValue(properties->stringValue);
 		_widget.lineEdit->setPlaceholderText(QString::fromStdString(properties->placeholderText));
 		break;
 	case WidgetType::NumberEdit:
-		_widget.lineEdit = new QLineEdit();
+		_widget.lineEdit = makeNative<QLineEdit>();
+		recordIfNeeded();
 		_widget.lineEdit->setValidator(new QIntValidator(_widget.lineEdit));
 		wrapIfNeeded(_widget.lineEdit);
 		if (!properties->intValue && properties->placeholderText.empty())
@@ -104,7 +425,8 @@ void BackendQt::create(StartupProperties* properties) {
 		_widget.lineEdit->setPlaceholderText(QString::fromStdString(properties->placeholderText));
 		break;
 	case WidgetType::FloatEdit:
-		_widget.lineEdit = new QLineEdit();
+		_widget.lineEdit = makeNative<QLineEdit>();
+		recordIfNeeded();
 		_widget.lineEdit->setValidator(new QDoubleValidator(_widget.lineEdit));
 		wrapIfNeeded(_widget.lineEdit);
 		if (!properties->doubleValue && properties->placeholderText.empty())
@@ -114,17 +436,58 @@ void BackendQt::create(StartupProperties* properties) {
 		_widget.lineEdit->setPlaceholderText(QString::fromStdString(properties->placeholderText));
 		break;
 	case WidgetType::CheckBox:
-		_widget.checkBox = new QCheckBox();
+		_widget.checkBox = makeNative<QCheckBox>();
+		recordIfNeeded();
 		wrapIfNeeded(_widget.checkBox);
 		if (properties->reaction)
 			addReaction(properties->reaction);
 		break;
 	case WidgetType::SpinBox:
-		_widget.spinBox = new QSpinBox();
+		_widget.spinBox = makeNative<QSpinBox>();
+		recordIfNeeded();
 		wrapIfNeeded(_widget.spinBox);
 		break;
+	case WidgetType::LogView:
+		_widget.logView = makeNative<BackendQtLogView>(properties->logBuffer);
+		wrapIfNeeded(_widget.logView);
+		break;
+	case WidgetType::ComboBox: {
+		_widget.lineEdit = makeNative<QLineEdit>();
+		_matches = new BackendQtMatches(_widget.lineEdit);
+		recordIfNeeded();
+		// Not attached through setCompleter(), it would filter the whole list by itself on every keystroke
+		QCompleter* completer = new QCompleter(_widget.lineEdit);
+		completer->setModel(_matches);
+		completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+		completer->setWidget(_widget.lineEdit);
+		if (auto list = qobject_cast<QListView*>(completer->popup()))
+			list->setUniformItemSizes(true);
+		QObject::connect(_widget.lineEdit, &QLineEdit::textEdited, [matches = _matches, completer] (const QString& text) {
+			matches->find(text.toStdString());
+			completer->complete();
+		});
+		QObject::connect(completer, static_cast<void(QCompleter::*)(const QModelIndex&)>(&QCompleter::activated),
+				[matches = _matches, edit = _widget.lineEdit] (const QModelIndex& index) {
+			matches->select(edit, matches->search.item(std::size_t(index.row())));
+		});
+		wrapIfNeeded(_widget.lineEdit);
+		if (properties->itemIndex)
+			setItems(properties->itemIndex);
+		if (properties->intValue >= 0)
+			setValue(properties->intValue);
+		if (properties->intReaction)
+			addValueChangedReacion(properties->intReaction);
+		_widget.lineEdit->setPlaceholderText(QString::fromStdString(properties->placeholderText));
+		break;
+	} case WidgetType::Progress:
+		_widget.progressBar = makeNative<QProgressBar>();
+		_widget.progressBar->setRange(0, 1000);
+		wrapIfNeeded(_widget.progressBar);
+		setValue(properties->doubleValue);
+		break;
 	case WidgetType::Button:
-		_widget.button = new QPushButton(QString::fromStdString(properties->title));
+		_widget.button = makeNative<QPushButton>(QString::fromStdString(properties->title));
+		recordIfNeeded();
 		if (properties->reaction)
 			addReaction(properties->reaction);
 		break;
@@ -137,10 +500,53 @@ void BackendQt::create(StartupProperties* properties) {
 	if (properties->stringReaction)
 		addValueChangedReacion(properties->stringReaction);
 
-	if (properties->windowed)
+	if (properties->windowed) {
+		if (_session)
+			_session->windowOpened(_container.window);
 		_container.window->exec();
+		if (_session)
+			_session->windowClosed(_id);
+		// Owns all the native widgets and with them all the connected reactions
+		delete _container.window;
+		forgetNatives();
+		// The widgets of the next window get the same numbers as those of this one
+		if (_session)
+			_session->widgets.resize(_id);
+	}
 };
 
+// Tasks can keep backend nodes alive after their window was deleted, they must find no natives then
+void BackendQt::forgetNatives() {
+	switch (_type) {
+	case WidgetType::Formulaire:
+	case WidgetType::HBox:
+	case WidgetType::VBox:
+		if (_auxiliary.children)
+			for (auto& it : *_auxiliary.children)
+				it->forgetNatives();
+		break;
+	default:
+		_auxiliary.description = nullptr;
+		break;
+	}
+	_widget.dummy = nullptr;
+	_container.dummy = nullptr;
+	_flat = false;
+	_matches = nullptr;
+}
+
+BackendQt::~BackendQt() {
+	switch (_type) {
+	case WidgetType::Formulaire:
+	case WidgetType::HBox:
+	case WidgetType::VBox:
+		delete _auxiliary.children;
+		break;
+	default:
+		break;
+	}
+}
+
 void BackendQt::setTitle(const std::string& title) {
 	switch (_type) {
 	case WidgetType::LineEdit:
@@ -148,7 +554,11 @@ void BackendQt::setTitle(const std::string& title) {
 	case WidgetType::FloatEdit:
 	case WidgetType::CheckBox:
 	case WidgetType::SpinBox:
-		_auxiliary.description->setText(QString::fromStdString(title));
+	case WidgetType::LogView:
+	case WidgetType::Progress:
+	case WidgetType::ComboBox:
+		if (_auxiliary.description)
+			_auxiliary.description->setText(QString::fromStdString(title));
 		break;
 	case WidgetType::Button:
 		_widget.button->setText(QString::fromStdString(title));
@@ -191,6 +601,9 @@ void BackendQt::addValueChangedReacion(const std::function<void(long long int)>&
 			reaction(value);
 		});
 		break;
+	case WidgetType::ComboBox:
+		_matches->reactions.push_back(reaction);
+		break;
 	default:
 		throw DuGuiError("Can't provide an int callback to a widget of type " + std::to_string(int(_type)));
 	}
@@ -239,6 +652,12 @@ void BackendQt::setValue(long long int value) {
 	case WidgetType::NumberEdit:
 		_widget.lineEdit->setText(QString::fromStdString(std::to_string(value)));
 		break;
+	case WidgetType::ComboBox:
+		if (value < 0 || !_matches->search.index() || std::size_t(value) >= _matches->search.index()->size())
+			_widget.lineEdit->clear();
+		else
+			_widget.lineEdit->setText(QString::fromStdString(_matches->search.index()->items()->label(std::size_t(value))));
+		break;
 	default:
 		throw DuGuiError("Can't set an integer value to a widget of type " + std::to_string(int(_type)));
 	}
@@ -249,18 +668,249 @@ void BackendQt::setValue(double value) {
 	case WidgetType::FloatEdit:
 		_widget.lineEdit->setText(QString::fromStdString(std::to_string(value)));
 		break;
+	case WidgetType::Progress:
+		_widget.progressBar->setValue(int(std::clamp(value, 0.0, 1.0) * 1000));
+		break;
 	default:
 		throw DuGuiError("Can't set a floating point value to a widget of type " + std::to_string(int(_type)));
 	}
 };
 
+void BackendQt::setItems(const std::shared_ptr<const PrefixIndex>& items) {
+	switch (_type) {
+	case WidgetType::ComboBox:
+		_matches->setIndex(items);
+		_matches->find(_widget.lineEdit->text().toStdString());
+		break;
+	default:
+		throw DuGuiError("Can't set items to a widget of type " + std::to_string(int(_type)));
+	}
+}
+
+void BackendQt::setEnabled(bool enabled) {
+	if (_widget.dummy) {
+		_widget.dummy->setEnabled(enabled);
+		if (_flat && _auxiliary.description) // The label has no wrapper to inherit it from
+			_auxiliary.description->setEnabled(enabled);
+	} else if (_flat)
+		for (auto& it : *_auxiliary.children)
+			it->setEnabled(enabled);
+	else if (_container.dummy)
+		_container.dummy->setEnabled(enabled);
+}
+
+void BackendQt::batchUpdates(bool batching) {
+	// Enabling updates again repaints everything that changed in the meantime at once
+	if (_flat) {
+		if (_widget.dummy) {
+			_widget.dummy->setUpdatesEnabled(!batching);
+			if (_auxiliary.description)
+				_auxiliary.description->setUpdatesEnabled(!batching);
+		} else
+			for (auto& it : *_auxiliary.children)
+				it->batchUpdates(batching);
+	} else if (_container.dummy)
+		_container.dummy->setUpdatesEnabled(!batching);
+	else if (_widget.dummy)
+		_widget.dummy->setUpdatesEnabled(!batching);
+}
+
+void BackendQt::runInGuiThread(const std::function<void()>& action) {
+	if (!QCoreApplication::instance())
+		return; // The application has ended, nothing would run it
+	QMetaObject::invokeMethod(QCoreApplication::instance(), action, Qt::QueuedConnection);
+}
+
 void BackendQt::close() {
 	if (!_windowed)
 		throw DuGuiError("Trying to close a widget that isn't a window");
+	if (!_container.window)
+		throw DuGuiError("Trying to close a window that is already closed");
 	_container.window->done(true);
 }
 
 std::shared_ptr<Backend> BackendQt::createAnotherElement() {
 	auto made = std::make_shared<BackendQt>();
+	made->_session = _session;
 	return made;
 };
+
+void BackendQt::record(InteractionTrace& trace) {
+	if (!_session)
+		_session = std::make_shared<BackendQtSession>();
+	_session->recording = &trace;
+	// The clock starts when the next window opens, like when replaying
+	_session->recordingStarted = false;
+}
+
+void BackendQt::replay(const InteractionTrace& trace, ReplaySpeed speed, ReplayReport& report) {
+	if (!_session)
+		_session = std::make_shared<BackendQtSession>();
+	_session->replaying = &trace;
+	_session->speed = speed;
+	_session->report = &report;
+	_session->replayStarted = false;
+	_session->replayFinished = false;
+	_session->scheduled = false;
+	_session->next = 0;
+	_session->latencies.clear();
+	report = ReplayReport();
+}
+
+void BackendQt::connectRecorder() {
+	using Kind = InteractionTrace::Kind;
+	auto record = [session = _session, id = _id] (Kind kind, long long int number, std::string text) {
+		session->record(id, kind, number, std::move(text));
+	};
+	switch (_type) {
+	case WidgetType::LineEdit:
+	case WidgetType::NumberEdit:
+	case WidgetType::FloatEdit:
+		QObject::connect(_widget.lineEdit, &QLineEdit::editingFinished, [record, edit = _widget.lineEdit] () {
+			record(Kind::Edited, 0, edit->text().toStdString());
+		});
+		break;
+	case WidgetType::ComboBox:
+		_matches->reactions.push_back([record] (long long int item) {
+			record(Kind::Selected, item, std::string());
+		});
+		break;
+	case WidgetType::CheckBox:
+		QObject::connect(_widget.checkBox, &QCheckBox::clicked, [record] (bool selected) {
+			record(Kind::Toggled, selected, std::string());
+		});
+		break;
+	case WidgetType::SpinBox:
+		QObject::connect(_widget.spinBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), [record] (int value) {
+			record(Kind::Changed, value, std::string());
+		});
+		break;
+	case WidgetType::Button:
+		QObject::connect(_widget.button, &QPushButton::clicked, [record] () {
+			record(Kind::Clicked, 0, std::string());
+		});
+		break;
+	default:
+		break;
+	}
+}
+
+bool BackendQt::replay(const InteractionTrace::Event& event) {
+	using Kind = InteractionTrace::Kind;
+	switch (event.kind) {
+	case Kind::Edited:
+		if (_type != WidgetType::LineEdit && _type != WidgetType::NumberEdit && _type != WidgetType::FloatEdit)
+			return false;
+		_widget.lineEdit->setText(QString::fromStdString(event.text));
+		emit _widget.lineEdit->editingFinished();
+		return true;
+	case Kind::Selected:
+		if (_type != WidgetType::ComboBox || !_matches->search.index() || std::size_t(event.number) >= _matches->search.index()->size())
+			return false;
+		_matches->select(_widget.lineEdit, std::size_t(event.number));
+		return true;
+	case Kind::Toggled:
+		if (_type != WidgetType::CheckBox)
+			return false;
+		_widget.checkBox->setChecked(event.number != 0);
+		emit _widget.checkBox->clicked(event.number != 0);
+		return true;
+	case Kind::Changed:
+		if (_type != WidgetType::SpinBox)
+			return false;
+		_widget.spinBox->setValue(int(event.number));
+		return true;
+	case Kind::Clicked:
+		if (_type != WidgetType::Button)
+			return false;
+		_widget.button->click();
+		return true;
+	case Kind::Closed:
+		return false; // Handled by the session
+	}
+	return false;
+}
+
+namespace {
+
+void writeNumber(std::ostream& out, std::uint64_t number) {
+	while (number >= 0x80) {
+		out.put(char((number & 0x7f) | 0x80));
+		number >>= 7;
+	}
+	out.put(char(number));
+}
+
+std::uint64_t readNumber(std::istream& in) {
+	std::uint64_t number = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		int byte = in.get();
+		if (byte == std::char_traits<char>::eof())
+			throw DuGuiError("Interaction trace is truncated");
+		number |= std::uint64_t(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return number;
+	}
+	throw DuGuiError("Interaction trace is corrupted");
+}
+
+const char traceMagic[] = "DuGUI trace 1";
+
+} // namespace
+
+// Variable length numbers, times are stored as differences from the previous event
+void InteractionTrace::write(std::ostream& out) const {
+	out.write(traceMagic, sizeof(traceMagic));
+	writeNumber(out, events.size());
+	std::uint64_t previous = 0;
+	for (const Event& it : events) {
+		writeNumber(out, it.time - previous);
+		previous = it.time;
+		writeNumber(out, it.widget);
+		out.put(char(it.kind));
+		writeNumber(out, (std::uint64_t(it.number) << 1) ^ std::uint64_t(it.number >> 63));
+		writeNumber(out, it.text.size());
+		out.write(it.text.data(), std::streamsize(it.text.size()));
+	}
+}
+
+void InteractionTrace::read(std::istream& in) {
+	char magic[sizeof(traceMagic)] = {};
+	in.read(magic, sizeof(magic));
+	if (!std::equal(magic, magic + sizeof(magic), traceMagic))
+		throw DuGuiError("Not an interaction trace");
+	events.clear();
+	// Read one by one, a corrupted count fails on the end of the file rather than on allocating
+	std::uint64_t count = readNumber(in);
+	std::uint64_t time = 0;
+	for (std::uint64_t i = 0; i < count; i++) {
+		Event& it = events.emplace_back();
+		time += readNumber(in);
+		it.time = time;
+		it.widget = std::uint32_t(readNumber(in));
+		int kind = in.get();
+		if (kind < 0 || kind > int(Kind::Closed))
+			throw DuGuiError("Interaction trace is corrupted");
+		it.kind = Kind(kind);
+		std::uint64_t number = readNumber(in);
+		it.number = (long long int)(number >> 1) ^ -(long long int)(number & 1);
+		std::uint64_t length = readNumber(in);
+		while (it.text.size() < length) {
+			char buffer[4096];
+			std::size_t chunk = std::size_t(std::min<std::uint64_t>(length - it.text.size(), sizeof(buffer)));
+			in.read(buffer, std::streamsize(chunk));
+			if (!in)
+				throw DuGuiError("Interaction trace is truncated");
+			it.text.append(buffer, chunk);
+		}
+	}
+}
+
+void ReplayReport::print(std::ostream& out) const {
+	out << "Replayed " << replayed << " events in " << seconds << " s (" << throughput() << " events/s), "
+			<< missed << " missed" << std::endl;
+	out << "widget\tcount\tmean\tmedian\tp90\tp99\tmax (us)" << std::endl;
+	for (const Latencies& it : reactions)
+		out << it.widget << '\t' << it.count << '\t' << it.mean << '\t' << it.median << '\t' << it.p90 << '\t'
+				<< it.p99 << '\t' << it.max << std::endl;
+}
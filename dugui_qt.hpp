@@ -1,6 +1,8 @@
 #ifndef DUGUI_QT_WIDGETS
 #define DUGUI_QT_WIDGETS
 #include "dugui.hpp"
+#include <cstdint>
+#include <iosfwd>
 
 class QPushButton;
 class QCheckBox;
@@ -11,14 +13,63 @@ class QWidget;
 class QBoxLayout;
 class QGridLayout;
 class QLabel;
+class QProgressBar;
 
 namespace DuGUI {
 
 class BackendQtWindow;
+class BackendQtLogView;
+class BackendQtMatches;
+struct BackendQtSession;
+
+// Native input events in the windows of a backend, widgets are numbered in the order of their creation
+struct InteractionTrace {
+	enum class Kind : unsigned char {
+		Edited,
+		Clicked,
+		Toggled,
+		Changed,
+		Selected,
+		Closed // A window closed, widget is the window's number
+	};
+	struct Event {
+		std::uint64_t time = 0; // microseconds since the recording started
+		std::uint32_t widget = 0;
+		Kind kind = Kind::Clicked;
+		long long int number = 0;
+		std::string text;
+	};
+	std::vector<Event> events;
+
+	void write(std::ostream& out) const;
+	void read(std::istream& in);
+};
+
+struct ReplayReport {
+	// Durations of the reactions of one widget, in microseconds
+	struct Latencies {
+		std::uint32_t widget = 0;
+		std::size_t count = 0;
+		double mean = 0;
+		double median = 0;
+		double p90 = 0;
+		double p99 = 0;
+		double max = 0;
+	};
+	std::size_t replayed = 0;
+	std::size_t missed = 0;
+	double seconds = 0;
+	std::vector<Latencies> reactions;
+
+	double throughput() const {
+		return seconds > 0 ? replayed / seconds : 0;
+	}
+	void print(std::ostream& out) const;
+};
 
 struct BackendQt final : public Backend {
-	WidgetType _type;
-	bool _windowed;
+	WidgetType _type = WidgetType::Unset;
+	bool _windowed = false;
 	union {
 		QWidget* dummy = nullptr;
 		QPushButton* button;
@@ -26,12 +77,17 @@ struct BackendQt final : public Backend {
 		QLineEdit* lineEdit;
 		QSlider* slider;
 		QSpinBox* spinBox;
+		BackendQtLogView* logView;
+		QProgressBar* progressBar;
 	} _widget;
 
+	// Without a border, a container's or a titled input's layout goes straight into the parent's layout
+	bool _flat = false;
 	union {
 		QWidget* dummy = nullptr;
 		BackendQtWindow* window;
 		QWidget* nonWindow;
+		QBoxLayout* layout;
 	} _container;
 
 	union {
@@ -39,7 +95,25 @@ struct BackendQt final : public Backend {
 		QLabel* description;
 		std::vector<std::shared_ptr<BackendQt>>* children;
 	} _auxiliary;
+
+	BackendQtMatches* _matches = nullptr;
+	std::shared_ptr<BackendQtSession> _session;
+	std::uint32_t _id = 0;
+	LiveCount<BackendQt, &LiveObjects::backends> _live;
+
+	~BackendQt() override;
+
+	enum class ReplaySpeed {
+		AsFastAsPossible,
+		Recorded
+	};
+	// Affect the windows created through this backend afterwards
+	void record(InteractionTrace& trace);
+	void replay(const InteractionTrace& trace, ReplaySpeed speed, ReplayReport& report);
+	bool replay(const InteractionTrace::Event& event);
 private:
+	void connectRecorder();
+	void forgetNatives();
 
 	void create(StartupProperties* properties) override;
 	void setTitle(const std::string& title) override;
@@ -50,6 +124,10 @@ private:
 	void setValue(const std::string& value) override;
 	void setValue(long long int value) override;
 	void setValue(double value) override;
+	void setItems(const std::shared_ptr<const PrefixIndex>& items) override;
+	void setEnabled(bool enabled) override;
+	void batchUpdates(bool batching) override;
+	void runInGuiThread(const std::function<void()>& action) override;
 	void close() override;
 	std::shared_ptr<Backend> createAnotherElement() override;
 };
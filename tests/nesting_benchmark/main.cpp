@@ -0,0 +1,109 @@
+// Counts the native widgets of a deeply nested form and measures the time from run() to its first paint
+#include "dugui.hpp"
+#include "dugui_qt.hpp"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using namespace DuGUI;
+
+struct Address : VBox {
+	Input<std::string> street = title("Street");
+	struct : HBox {
+		Input<std::string> city = placeholderText("City");
+		Input<int> code = placeholderText("Postal code");
+	} city = {{ noBorder() }};
+};
+
+struct Person : HBox {
+	struct : VBox {
+		Input<std::string> first = title("First name");
+		Input<std::string> last = title("Last name");
+		Input<int> age = title("Age");
+	} name = {{ noBorder() }};
+	Address address = {{ noBorder() }};
+	Input<bool> active = title("Active");
+	Button remove = title("Remove");
+};
+
+struct NestedForm : VBox {
+	Title t = title("Nested form");
+	Person person0 = {{ noBorder() }};
+	Person person1 = {{ noBorder() }};
+	Person person2 = {{ noBorder() }};
+	Person person3 = {{ noBorder() }};
+	Person person4 = {{ noBorder() }};
+	Person person5 = {{ noBorder() }};
+	Person person6 = {{ noBorder() }};
+	Person person7 = {{ noBorder() }};
+	Person person8 = {{ standardBorder().title("Group 8") }};
+	Person person9 = {{ standardBorder().title("Group 9") }};
+	struct : HBox {
+		Button cancel = title("Cancel");
+		Button save = title("Save");
+	} buttons = {{ noBorder() }};
+};
+
+// Calls the callback once, on the first paint event of any widget
+class FirstPaint : public QObject {
+	std::function<void()> _callback;
+public:
+	FirstPaint(const std::function<void()>& callback) : _callback(callback) {
+	}
+	bool eventFilter(QObject* watched, QEvent* event) override {
+		if (event->type() == QEvent::Paint && _callback) {
+			auto callback = std::move(_callback);
+			_callback = nullptr;
+			callback();
+		}
+		return QObject::eventFilter(watched, event);
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	QApplication application(argc, argv);
+
+	const int runs = argc > 1 ? std::atoi(argv[1]) : 200;
+
+	DuGUI::BackendQt backend;
+	LiveObjects& live = LiveObjects::get();
+	long long nativeWidgets = 0;
+	std::vector<double> times;
+
+	for (int i = 0; i < runs; i++) {
+		NestedForm form;
+		QElapsedTimer timer;
+		FirstPaint firstPaint([&] {
+			times.push_back(timer.nsecsElapsed() / 1000.0);
+			nativeWidgets = live.nativeWidgets;
+			QTimer::singleShot(0, [&form] {
+				form.close();
+			});
+		});
+		application.installEventFilter(&firstPaint);
+		QTimer::singleShot(10000, &firstPaint, [&form] {
+			form.close(); // Never painted
+		});
+		timer.start();
+		form.run(backend);
+		application.removeEventFilter(&firstPaint);
+	}
+
+	if (times.size() < size_t(runs) || times.empty()) {
+		std::cerr << runs - times.size() << " of " << runs << " windows weren't painted" << std::endl;
+		return 1;
+	}
+	std::sort(times.begin(), times.end());
+	std::cout << "Native widgets: " << nativeWidgets << std::endl;
+	std::cout << "Time to first paint over " << times.size() << " runs: median " << times[times.size() / 2]
+			<< " us, fastest " << times.front() << " us, slowest " << times.back() << " us" << std::endl;
+	return 0;
+}
@@ -0,0 +1,18 @@
+QT       += core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# Point to another checkout to compare, e.g. qmake DUGUI_DIR=../../../dugui-before
+isEmpty(DUGUI_DIR): DUGUI_DIR = ../..
+
+TARGET = nesting_benchmark
+INCLUDEPATH += $$DUGUI_DIR
+
+SOURCES += \
+	main.cpp \
+	$$DUGUI_DIR/dugui_qt.cpp
+
+HEADERS += \
+	$$DUGUI_DIR/dugui.hpp \
+	$$DUGUI_DIR/dugui_qt.hpp
@@ -0,0 +1,107 @@
+// Opens and closes a large form many times, fails if any object outlives its window or if memory keeps growing
+#include "dugui.hpp"
+#include "dugui_qt.hpp"
+#include <QApplication>
+#include <QTimer>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+using namespace DuGUI;
+
+struct Row : HBox {
+	Input<std::string> name = placeholderText("Name");
+	Input<int> count = placeholderText("Count");
+	Button remove = title("Remove");
+};
+
+struct LargeForm : Formulaire {
+	Title t = title("Large form");
+	Row row0 = {{ noBorder().title("Row 0") }};
+	Row row1 = {{ noBorder().title("Row 1") }};
+	Row row2 = {{ noBorder().title("Row 2") }};
+	Row row3 = {{ noBorder().title("Row 3") }};
+	Row row4 = {{ noBorder().title("Row 4") }};
+	Row row5 = {{ noBorder().title("Row 5") }};
+	Row row6 = {{ noBorder().title("Row 6") }};
+	Row row7 = {{ noBorder().title("Row 7") }};
+	Row row8 = {{ noBorder().title("Row 8") }};
+	Row row9 = {{ noBorder().title("Row 9") }};
+	Row row10 = {{ standardBorder().title("Row 10") }};
+	Row row11 = {{ standardBorder().title("Row 11") }};
+	Row row12 = {{ standardBorder().title("Row 12") }};
+	Row row13 = {{ standardBorder().title("Row 13") }};
+	Row row14 = {{ standardBorder().title("Row 14") }};
+	Input<std::string> address = title("Address");
+	ComboBox<std::string> host = title("Host");
+	Progress progress = title("Progress");
+	LogView log = title("Log").maxLines(100);
+	Button submit = title("Submit").reaction([this] {
+		close();
+	});
+};
+
+static long residentKilobytes() {
+	std::ifstream statm("/proc/self/statm");
+	long size = 0;
+	long resident = 0;
+	statm >> size >> resident;
+	return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+int main(int argc, char* argv[])
+{
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	QApplication application(argc, argv);
+
+	const int cycles = argc > 1 ? std::atoi(argv[1]) : 10000;
+	const int warmup = std::min(500, cycles / 10);
+	const long allowedGrowth = 4096; // kB, the allocator doesn't give everything back at once
+
+	std::vector<std::string> hosts;
+	for (int i = 0; i < 100; i++)
+		hosts.push_back("host" + std::to_string(i) + ".example.com");
+
+	DuGUI::BackendQt backend;
+	LiveObjects& live = LiveObjects::get();
+	const long long widgets = live.widgets;
+	const long long properties = live.properties;
+	const long long backends = live.backends;
+	const long long bytes = live.shallowBytes;
+	long baseline = 0;
+
+	for (int i = 0; i < cycles; i++) {
+		{
+			LargeForm form;
+			form.host.setItems(hosts);
+			form.log.append("Cycle " + std::to_string(i) + "\nsecond line");
+			QTimer::singleShot(0, [&form] {
+				form.progress = 0.5;
+				form.row3.name = "Edited";
+				form.close();
+			});
+			form.run(backend);
+		}
+		QCoreApplication::processEvents();
+
+		if (live.nativeWidgets != 0 || live.widgets != widgets || live.properties != properties
+				|| live.backends != backends || live.shallowBytes != bytes) {
+			std::cerr << "Objects outlived their window in cycle " << i << ": " << live.nativeWidgets << " native widgets, "
+					<< live.widgets - widgets << " widgets, " << live.properties - properties << " properties, "
+					<< live.backends - backends << " backends, " << live.shallowBytes - bytes << " bytes" << std::endl;
+			return 1;
+		}
+		if (i == warmup)
+			baseline = residentKilobytes();
+	}
+
+	long end = residentKilobytes();
+	std::cout << cycles << " cycles, resident memory " << baseline << " kB after " << warmup << " cycles, "
+			<< end << " kB at the end" << std::endl;
+	if (end - baseline > allowedGrowth) {
+		std::cerr << "Resident memory grew by " << end - baseline << " kB" << std::endl;
+		return 1;
+	}
+	return 0;
+}
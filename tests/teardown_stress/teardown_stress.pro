@@ -0,0 +1,15 @@
+QT       += core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = teardown_stress
+INCLUDEPATH += ../..
+
+SOURCES += \
+	main.cpp \
+	../../dugui_qt.cpp
+
+HEADERS += \
+	../../dugui.hpp \
+	../../dugui_qt.hpp